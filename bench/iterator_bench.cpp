@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include "Vector.hpp"
+
+// usage: iterator_bench [elements]
+// runs the same std algorithms over begin()..end() and over data()..data() + size(),
+// a ratio above 1 is what the iterator costs compared to raw pointers
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using Data = custom::Vector<int>;
+
+    constexpr int kRepeats = 5;
+
+    // keeps the results from being optimized away
+    volatile long long g_sink = 0;
+
+    // best of kRepeats, prepare() runs before every run and is not timed
+    template <typename Prepare, typename Run>
+    double best_ms(Prepare prepare, Run run)
+    {
+        double best = 0;
+        for (int i = 0; i < kRepeats; ++i)
+        {
+            prepare();
+            Clock::time_point start = Clock::now();
+            run();
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (i == 0 || ms < best) best = ms;
+        }
+        return best;
+    }
+
+    void report(const char* name, double iterators, double pointers)
+    {
+        std::printf("%-12s %14.2f %14.2f %8.2f\n", name, iterators, pointers, iterators / pointers);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    std::mt19937 rng(1);
+    Data input;
+    input.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) input.push_back(static_cast<int>(rng() >> 1));
+
+    Data a(input);
+    Data b(n, 0);
+    auto none = [] {};
+    auto reset = [&] { std::copy(input.data(), input.data() + n, a.data()); };
+
+    // looked for but never present, so find walks the whole range
+    const int missing = -1;
+
+    std::printf("%zu ints, best of %d runs\n\n", n, kRepeats);
+    std::printf("%-12s %14s %14s %8s\n", "algorithm", "begin() ms", "data() ms", "ratio");
+
+    double copyIt = best_ms(none, [&] { std::copy(a.begin(), a.end(), b.begin()); });
+    double copyPtr = best_ms(none, [&] { std::copy(a.data(), a.data() + n, b.data()); });
+    report("copy", copyIt, copyPtr);
+
+    double fillIt = best_ms(none, [&] { std::fill(b.begin(), b.end(), 7); });
+    double fillPtr = best_ms(none, [&] { std::fill(b.data(), b.data() + n, 7); });
+    report("fill", fillIt, fillPtr);
+
+    double sumIt = best_ms(none, [&] { g_sink = std::accumulate(a.begin(), a.end(), 0ll); });
+    double sumPtr = best_ms(none, [&] { g_sink = std::accumulate(a.data(), a.data() + n, 0ll); });
+    report("accumulate", sumIt, sumPtr);
+
+    double findIt = best_ms(none, [&] { g_sink = std::find(a.begin(), a.end(), missing) - a.begin(); });
+    double findPtr = best_ms(none, [&]
+    {
+        g_sink = std::find(a.data(), a.data() + n, missing) - a.data();
+    });
+    report("find", findIt, findPtr);
+
+    double sortIt = best_ms(reset, [&] { std::sort(a.begin(), a.end()); });
+    double sortPtr = best_ms(reset, [&] { std::sort(a.data(), a.data() + n); });
+    report("sort", sortIt, sortPtr);
+
+    // std::copy only turns into memmove for raw pointers, class-type iterators take the
+    // element loop even when they are contiguous; measured against memmove itself
+    double memmoveMs = best_ms(none, [&] { std::memmove(b.data(), a.data(), n * sizeof(int)); });
+
+    std::printf("\ncopy lowering: Vector<int>::iterator is %s raw pointer, std::copy over "
+                "begin()..end() %s memmove\n",
+                std::is_pointer<Data::iterator>::value ? "a" : "not a",
+                std::is_pointer<Data::iterator>::value ? "uses" : "does not use");
+    std::printf("%-12s %14.2f %14.2f %8.2f\n", "copy/memmove", copyIt, memmoveMs, copyIt / memmoveMs);
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include "PackedIntVector.hpp"
+
+// usage: packed_bench [elements]
+// for every data set the plain Vector<uint64_t> row is the baseline, the packed rows show
+// memory_usage() and scan throughput of decode(), decode_block() and get() per encoding
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using Data = custom::Vector<std::uint64_t>;
+    using Packed = custom::PackedIntVector<>;
+
+    constexpr int kRepeats = 3;
+
+    // keeps the scans from being optimized away
+    volatile std::uint64_t g_sink = 0;
+
+    template <typename Run>
+    double best_ms(Run run)
+    {
+        double best = 0;
+        for (int i = 0; i < kRepeats; ++i)
+        {
+            Clock::time_point start = Clock::now();
+            run();
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (i == 0 || ms < best) best = ms;
+        }
+        return best;
+    }
+
+    double mvals(std::size_t n, double ms)
+    {
+        return n / (ms * 1000.0);
+    }
+
+    const char* encoding_name(custom::PackedEncoding encoding)
+    {
+        switch (encoding)
+        {
+        case custom::PackedEncoding::FrameOfReference: return "FrameOfReference";
+        case custom::PackedEncoding::Delta: return "Delta";
+        default: return "Plain";
+        }
+    }
+
+    void bench_data(const char* name, const Data& input)
+    {
+        std::size_t n = input.size();
+        Data out;
+        out.reserve(n);
+
+        double sum = best_ms([&]
+        {
+            std::uint64_t acc = 0;
+            for (std::size_t i = 0; i < n; ++i) acc += input[i];
+            g_sink = acc;
+        });
+        double copy = best_ms([&] { out = input; });
+        std::size_t bytes = sizeof(input) + input.capacity() * sizeof(std::uint64_t);
+
+        std::printf("\n%s\n", name);
+        std::printf("  %-18s %12zu %7.3f %12.0f %12.0f %12.0f\n", "Vector<uint64_t>", bytes, 1.0,
+                    mvals(n, copy), mvals(n, sum), mvals(n, sum));
+
+        const custom::PackedEncoding encodings[] = {custom::PackedEncoding::Plain,
+                                                    custom::PackedEncoding::FrameOfReference,
+                                                    custom::PackedEncoding::Delta};
+        for (custom::PackedEncoding encoding : encodings)
+        {
+            Packed packed(encoding);
+            for (std::size_t i = 0; i < n; ++i) packed.push_back(input[i]);
+
+            double decode = best_ms([&] { packed.decode(out); });
+            double blocks = best_ms([&]
+            {
+                std::uint64_t values[Packed::kBlockSize];
+                std::uint64_t acc = 0;
+                for (std::size_t block = 0; block < packed.block_count(); ++block)
+                {
+                    std::size_t count = packed.decode_block(block, values);
+                    for (std::size_t i = 0; i < count; ++i) acc += values[i];
+                }
+                g_sink = acc;
+            });
+            double get = best_ms([&]
+            {
+                std::uint64_t acc = 0;
+                for (std::size_t i = 0; i < n; ++i) acc += packed.get(i);
+                g_sink = acc;
+            });
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (out[i] != input[i])
+                {
+                    std::printf("  %s decoded a wrong value at %zu\n", encoding_name(encoding), i);
+                    std::exit(1);
+                }
+            }
+
+            std::printf("  %-18s %12zu %7.3f %12.0f %12.0f %12.0f\n", encoding_name(encoding),
+                        packed.memory_usage(), double(packed.memory_usage()) / bytes,
+                        mvals(n, decode), mvals(n, blocks), mvals(n, get));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    std::printf("%zu elements, best of %d runs, throughput in Mvals/s\n", n, kRepeats);
+    std::printf("(for Vector<uint64_t> decode is a copy and both scans are a plain loop)\n\n");
+    std::printf("  %-18s %12s %7s %12s %12s %12s\n", "layout", "bytes", "ratio",
+                "decode", "block scan", "get scan");
+
+    std::mt19937_64 rng(1);
+    Data data;
+    data.reserve(n);
+
+    for (std::size_t i = 0; i < n; ++i) data.push_back(rng() & 0xfff);
+    bench_data("small values, 12 bits", data);
+
+    data.resize(0);
+    for (std::size_t i = 0; i < n; ++i) data.push_back(1000000000000ull + (rng() & 0xffff));
+    bench_data("large values in a narrow range, 16 bits above 1e12", data);
+
+    data.resize(0);
+    std::uint64_t timestamp = 1700000000000ull;
+    for (std::size_t i = 0; i < n; ++i) data.push_back(timestamp += rng() & 0x3f);
+    bench_data("increasing timestamps, gaps below 64", data);
+
+    data.resize(0);
+    for (std::size_t i = 0; i < n; ++i) data.push_back(rng());
+    bench_data("random 64 bit values", data);
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include "Parallel.hpp"
+
+// usage: parallel_bench [elements] [max workers]
+// every algorithm runs against its sequential std counterpart on the same input, the
+// worker count doubles from 1 up to max workers (hardware_concurrency by default)
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using Data = custom::Vector<std::uint64_t>;
+
+    constexpr int kRepeats = 3;
+
+    // best of kRepeats, prepare() restores the input before every run and is not timed
+    template <typename Prepare, typename Run>
+    double best_ms(Prepare prepare, Run run)
+    {
+        double best = 0;
+        for (int i = 0; i < kRepeats; ++i)
+        {
+            prepare();
+            Clock::time_point start = Clock::now();
+            run();
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (i == 0 || ms < best) best = ms;
+        }
+        return best;
+    }
+
+    Data make_input(std::size_t n, std::uint64_t distinct, std::uint64_t seed)
+    {
+        std::mt19937_64 rng(seed);
+        Data data;
+        data.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+            data.push_back(distinct ? rng() % distinct : rng());
+        return data;
+    }
+
+    void report(const char* name, std::size_t workers, double baseline, double ms)
+    {
+        std::printf("%-24s %8zu %12.1f %12.1f %8.2fx\n", name, workers, baseline, ms, baseline / ms);
+    }
+
+    void bench_sorts(const char* name, const Data& input, std::size_t maxWorkers)
+    {
+        Data data;
+        auto reset = [&] { data = input; };
+
+        std::string sortName = std::string("sort/") + name;
+        std::string stableName = std::string("stable_sort/") + name;
+
+        double sortBase = best_ms(reset, [&] { std::sort(data.begin(), data.end()); });
+        double stableBase = best_ms(reset, [&] { std::stable_sort(data.begin(), data.end()); });
+
+        for (std::size_t workers = 1; workers <= maxWorkers; workers *= 2)
+        {
+            custom::ThreadPool pool(workers);
+            double ms = best_ms(reset, [&]
+            {
+                custom::parallel::sort(data, std::less<std::uint64_t>(), pool);
+            });
+            report(sortName.c_str(), workers, sortBase, ms);
+        }
+
+        for (std::size_t workers = 1; workers <= maxWorkers; workers *= 2)
+        {
+            custom::ThreadPool pool(workers);
+            double ms = best_ms(reset, [&]
+            {
+                custom::parallel::stable_sort(data, std::less<std::uint64_t>(), pool);
+            });
+            report(stableName.c_str(), workers, stableBase, ms);
+        }
+    }
+
+    void bench_elementwise(const Data& input, std::size_t maxWorkers)
+    {
+        auto mix = [](std::uint64_t& x) { x ^= x >> 7; x *= 0x9e3779b97f4a7c15ull; };
+        auto root = [](std::uint64_t x) { return std::sqrt(static_cast<double>(x)); };
+
+        Data data;
+        custom::Vector<double> out;
+        auto reset = [&] { data = input; };
+        auto none = [] {};
+
+        // transform always writes into a fresh vector, so growing it is part of the timing
+        auto fresh = [&] { out = custom::Vector<double>(); };
+
+        // keeps the reductions from being optimized away
+        volatile std::uint64_t sink = 0;
+
+        double eachBase = best_ms(reset, [&] { std::for_each(data.begin(), data.end(), mix); });
+        double transformBase = best_ms(fresh, [&]
+        {
+            out.reserve(input.size());
+            for (std::size_t i = 0; i < input.size(); ++i) out.push_back(root(input[i]));
+        });
+        double reduceBase = best_ms(none, [&]
+        {
+            sink = std::accumulate(input.begin(), input.end(), std::uint64_t(0));
+        });
+
+        for (std::size_t workers = 1; workers <= maxWorkers; workers *= 2)
+        {
+            custom::ThreadPool pool(workers);
+
+            double each = best_ms(reset, [&] { custom::parallel::for_each(data, mix, pool); });
+            double transform = best_ms(fresh, [&]
+            {
+                custom::parallel::transform(input, out, root, pool);
+            });
+            double reduce = best_ms(none, [&]
+            {
+                sink = custom::parallel::reduce(input, std::uint64_t(0), std::plus<>(), pool);
+            });
+
+            report("for_each", workers, eachBase, each);
+            report("transform", workers, transformBase, transform);
+            report("reduce", workers, reduceBase, reduce);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    std::size_t maxWorkers = argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                                      : std::thread::hardware_concurrency();
+    if (maxWorkers == 0) maxWorkers = 1;
+
+    std::printf("%zu elements, best of %d runs, up to %zu workers\n\n", n, kRepeats, maxWorkers);
+    std::printf("%-24s %8s %12s %12s %9s\n", "algorithm", "workers", "std ms", "parallel ms", "speedup");
+
+    bench_sorts("random", make_input(n, 0, 1), maxWorkers);
+    bench_sorts("4_distinct", make_input(n, 4, 2), maxWorkers);
+    bench_sorts("all_equal", make_input(n, 1, 3), maxWorkers);
+    bench_elementwise(make_input(n, 0, 4), maxWorkers);
+
+    return 0;
+}
@@ -0,0 +1,275 @@
+#ifndef __CUSTOM_MEMORY_RESOURCE__
+#define __CUSTOM_MEMORY_RESOURCE__
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+namespace custom
+{
+    ////////////////////////////////////////////////////////////////////////////////////////
+    class MemoryResource
+    {
+    public:
+        virtual ~MemoryResource() = default;
+
+        void* allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t));
+        void deallocate(void* ptr, std::size_t bytes,
+                        std::size_t align = alignof(std::max_align_t));
+        bool is_equal(const MemoryResource& other) const noexcept;
+
+    private:
+        virtual void* do_allocate(std::size_t bytes, std::size_t align) = 0;
+        virtual void do_deallocate(void* ptr, std::size_t bytes, std::size_t align) = 0;
+        virtual bool do_is_equal(const MemoryResource& other) const noexcept = 0;
+    };
+
+    bool operator == (const MemoryResource& a, const MemoryResource& b) noexcept;
+    bool operator != (const MemoryResource& a, const MemoryResource& b) noexcept;
+
+    MemoryResource* new_delete_resource() noexcept;
+    MemoryResource* null_memory_resource() noexcept;
+    MemoryResource* get_default_resource() noexcept;
+    MemoryResource* set_default_resource(MemoryResource* resource) noexcept;
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // Bump allocator over a chain of upstream chunks: deallocate is a no-op,
+    // everything is returned at once by release() or destructor.
+    class MonotonicBufferResource : public MemoryResource
+    {
+    private:
+        struct Chunk
+        {
+            Chunk* m_next;
+            std::size_t m_size;
+            std::size_t m_align;
+        };
+
+        MemoryResource* m_upstream;
+        void* m_initialBuffer;
+        std::size_t m_initialSize;
+        char* m_current;
+        std::size_t m_left;
+        std::size_t m_nextSize;
+        Chunk* m_chunks = nullptr;
+
+    public:
+        explicit MonotonicBufferResource(MemoryResource* upstream = get_default_resource());
+        MonotonicBufferResource(std::size_t initialSize,
+                                MemoryResource* upstream = get_default_resource());
+        MonotonicBufferResource(void* buffer, std::size_t size,
+                                MemoryResource* upstream = get_default_resource());
+
+        MonotonicBufferResource(const MonotonicBufferResource&) = delete;
+        MonotonicBufferResource& operator = (const MonotonicBufferResource&) = delete;
+
+        ~MonotonicBufferResource() override;
+
+        void release();
+        MemoryResource* upstream_resource() const;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t align) override;
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t align) override;
+        bool do_is_equal(const MemoryResource& other) const noexcept override;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    struct PoolOptions
+    {
+        std::size_t max_blocks_per_chunk = 0;
+        std::size_t largest_required_pool_block = 0;
+    };
+
+    // Power-of-two size classes, each with its own free list carved from upstream
+    // chunks. Requests above the largest class go straight to upstream.
+    class UnsynchronizedPoolResource : public MemoryResource
+    {
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* m_next;
+        };
+
+        struct Chunk
+        {
+            Chunk* m_next;
+            std::size_t m_size;
+            std::size_t m_align;
+        };
+
+        struct Pool
+        {
+            std::size_t m_blockSize = 0;
+            std::size_t m_nextBlocks = 0;
+            FreeBlock* m_free = nullptr;
+            Chunk* m_chunks = nullptr;
+        };
+
+        // sits right in front of every block too big for the pools, so deallocation finds it
+        // without a search; the list only exists for release()
+        struct LargeBlock
+        {
+            LargeBlock* m_prev;
+            LargeBlock* m_next;
+            std::size_t m_offset; // from the upstream allocation to the returned pointer
+            std::size_t m_size;
+            std::size_t m_align;
+        };
+
+        static constexpr std::size_t kMinBlock = 8;
+        static constexpr std::size_t kMaxPools = 32;
+
+        MemoryResource* m_upstream;
+        PoolOptions m_options;
+        Pool m_pools[kMaxPools];
+        std::size_t m_poolCount = 0;
+        LargeBlock* m_large = nullptr;
+
+        Pool* find_pool(std::size_t bytes, std::size_t align);
+        void refill(Pool& pool);
+
+    public:
+        explicit UnsynchronizedPoolResource(MemoryResource* upstream = get_default_resource());
+        UnsynchronizedPoolResource(const PoolOptions& options,
+                                   MemoryResource* upstream = get_default_resource());
+
+        UnsynchronizedPoolResource(const UnsynchronizedPoolResource&) = delete;
+        UnsynchronizedPoolResource& operator = (const UnsynchronizedPoolResource&) = delete;
+
+        ~UnsynchronizedPoolResource() override;
+
+        void release();
+        MemoryResource* upstream_resource() const;
+        PoolOptions options() const;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t align) override;
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t align) override;
+        bool do_is_equal(const MemoryResource& other) const noexcept override;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    class SynchronizedPoolResource : public MemoryResource
+    {
+    private:
+        std::mutex m_mutex;
+        UnsynchronizedPoolResource m_pool;
+
+    public:
+        explicit SynchronizedPoolResource(MemoryResource* upstream = get_default_resource());
+        SynchronizedPoolResource(const PoolOptions& options,
+                                 MemoryResource* upstream = get_default_resource());
+
+        void release();
+        MemoryResource* upstream_resource() const;
+        PoolOptions options() const;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t align) override;
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t align) override;
+        bool do_is_equal(const MemoryResource& other) const noexcept override;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // Allocator whose behaviour is chosen at runtime by the resource it points to,
+    // so Vector<T, PolymorphicAllocator<T>> is one type for every arena.
+    template <typename T>
+    class PolymorphicAllocator
+    {
+    private:
+        MemoryResource* m_resource;
+
+    public:
+        using value_type = T;
+
+        PolymorphicAllocator() noexcept;
+        PolymorphicAllocator(MemoryResource* resource) noexcept;
+
+        template <typename U>
+        PolymorphicAllocator(const PolymorphicAllocator<U>& other) noexcept;
+
+        PolymorphicAllocator(const PolymorphicAllocator&) = default;
+        PolymorphicAllocator& operator = (const PolymorphicAllocator&) = default;
+
+        T* allocate(std::size_t n);
+        void deallocate(T* ptr, std::size_t n);
+
+        PolymorphicAllocator select_on_container_copy_construction() const;
+        MemoryResource* resource() const;
+    };
+
+    template <typename T, typename U>
+    bool operator == (const PolymorphicAllocator<T>& a, const PolymorphicAllocator<U>& b) noexcept;
+
+    template <typename T, typename U>
+    bool operator != (const PolymorphicAllocator<T>& a, const PolymorphicAllocator<U>& b) noexcept;
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    PolymorphicAllocator<T>::PolymorphicAllocator() noexcept
+        : m_resource(get_default_resource())
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    PolymorphicAllocator<T>::PolymorphicAllocator(MemoryResource* resource) noexcept
+        : m_resource(resource)
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    template <typename U>
+    PolymorphicAllocator<T>::PolymorphicAllocator(const PolymorphicAllocator<U>& other) noexcept
+        : m_resource(other.resource())
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    T* PolymorphicAllocator<T>::allocate(std::size_t n)
+    {
+        if (n > static_cast<std::size_t>(-1) / sizeof(T))
+            throw std::bad_array_new_length();
+
+        return static_cast<T*>(m_resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    void PolymorphicAllocator<T>::deallocate(T* ptr, std::size_t n)
+    {
+        m_resource->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    PolymorphicAllocator<T>
+    PolymorphicAllocator<T>::select_on_container_copy_construction() const
+    {
+        return PolymorphicAllocator<T>();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    MemoryResource* PolymorphicAllocator<T>::resource() const
+    {
+        return m_resource;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename U>
+    bool operator == (const PolymorphicAllocator<T>& a, const PolymorphicAllocator<U>& b) noexcept
+    {
+        return *a.resource() == *b.resource();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename U>
+    bool operator != (const PolymorphicAllocator<T>& a, const PolymorphicAllocator<U>& b) noexcept
+    {
+        return !(a == b);
+    }
+};
+
+#endif // __CUSTOM_MEMORY_RESOURCE__
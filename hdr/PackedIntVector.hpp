@@ -0,0 +1,473 @@
+#ifndef __CUSTOM_PACKED_INT_VECTOR__
+#define __CUSTOM_PACKED_INT_VECTOR__
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "Vector.hpp"
+
+// the AVX2 decode is compiled with a target attribute and picked at runtime,
+// so it does not depend on -mavx2 being passed to the whole build
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define __CUSTOM_PACKED_AVX2__
+#endif
+
+namespace custom
+{
+    ////////////////////////////////////////////////////////////////////////////////////////
+    enum class PackedEncoding
+    {
+        Plain,            // value stored as is
+        FrameOfReference, // value - min of its block
+        Delta             // zigzag(value - previous value), first value of block is the base
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // Integers are grouped in blocks of kBlockSize values, every block is packed with its
+    // own bit width, so a block of width w occupies exactly 2 * w words. Only the last
+    // block is ever repacked: push_back widens (or rebases) it when a value does not fit.
+    // get() is O(1) for Plain and FrameOfReference, Delta has to sum up to kBlockSize
+    // deltas of one block.
+    template <typename Alloc = StandartAllocator<std::uint64_t>>
+    class PackedIntVector
+    {
+    public:
+        static constexpr std::size_t kBlockSize = 128;
+
+    private:
+        struct BlockHeader
+        {
+            std::uint64_t m_base;
+            std::size_t m_offset;
+            std::uint8_t m_width;
+        };
+
+        using HeaderAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<BlockHeader>;
+
+        PackedEncoding m_encoding;
+        Vector<std::uint64_t, Alloc> m_words;    // blocks + one padding word
+        Vector<BlockHeader, HeaderAlloc> m_headers;
+        std::size_t m_size = 0;
+        std::uint64_t m_last = 0;
+
+        static std::uint8_t bit_width(std::uint64_t x);
+        static std::uint64_t zigzag(std::uint64_t delta);
+        static std::uint64_t unzigzag(std::uint64_t code);
+        static void unpack(const std::uint64_t* words, std::uint8_t width, std::uint64_t base,
+                           std::size_t count, std::uint64_t* out);
+
+#if defined(__CUSTOM_PACKED_AVX2__)
+        static bool has_avx2();
+
+        __attribute__((target("avx2")))
+        static std::size_t unpack_avx2(const unsigned char* bytes, std::uint8_t width,
+                                       std::uint64_t base, std::size_t count,
+                                       std::uint64_t* out);
+#endif
+
+        std::uint64_t extract(const BlockHeader& header, std::size_t idx) const;
+        std::uint64_t stored_value(const BlockHeader& header, std::uint64_t value) const;
+        void resize_words(std::size_t n);
+        void write_tail(const std::uint64_t* values, std::size_t count);
+
+    public:
+        PackedIntVector(PackedEncoding encoding = PackedEncoding::Plain,
+                        const Alloc& alloc = Alloc());
+
+        std::size_t size() const;
+        std::size_t block_count() const;
+        std::size_t block_size(std::size_t block) const;
+        std::uint8_t block_width(std::size_t block) const;
+        PackedEncoding encoding() const;
+        std::size_t memory_usage() const;
+
+        std::uint64_t get(std::size_t i) const;
+        std::uint64_t operator [] (std::size_t i) const;
+        std::uint64_t at(std::size_t i) const;
+
+        void push_back(std::uint64_t value);
+
+        // makes room for n values packed at width bits each, 0 takes the widest block so far
+        void reserve(std::size_t n, std::uint8_t width = 0);
+        void clear();
+
+        std::size_t decode_block(std::size_t block, std::uint64_t* out) const;
+
+        template <typename VecAlloc>
+        void decode(Vector<std::uint64_t, VecAlloc>& out) const;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::uint8_t PackedIntVector<Alloc>::bit_width(std::uint64_t x)
+    {
+#if defined(__GNUC__)
+        return x ? 64 - __builtin_clzll(x) : 0;
+#else
+        std::uint8_t width = 0;
+        for (; x; x >>= 1) ++width;
+        return width;
+#endif
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::uint64_t PackedIntVector<Alloc>::zigzag(std::uint64_t delta)
+    {
+        return (delta << 1) ^ (0 - (delta >> 63));
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::uint64_t PackedIntVector<Alloc>::unzigzag(std::uint64_t code)
+    {
+        return (code >> 1) ^ (0 - (code & 1));
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    void PackedIntVector<Alloc>::unpack(const std::uint64_t* words, std::uint8_t width,
+                                        std::uint64_t base, std::size_t count,
+                                        std::uint64_t* out)
+    {
+        std::size_t i = 0;
+        if (width == 0)
+        {
+            for (; i < count; ++i) out[i] = base;
+            return;
+        }
+
+        std::uint64_t mask = width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+
+        // up to 56 bits a value fits into the 8 bytes starting at its first byte,
+        // so one unaligned load per value is enough
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(words);
+
+#if defined(__CUSTOM_PACKED_AVX2__)
+        if (width <= 56 && has_avx2()) i = unpack_avx2(bytes, width, base, count, out);
+#endif
+
+        for (; width <= 56 && i < count; ++i)
+        {
+            std::size_t bit = i * width;
+            std::uint64_t value;
+            std::memcpy(&value, bytes + (bit >> 3), sizeof(value));
+            out[i] = ((value >> (bit & 7)) & mask) + base;
+        }
+
+        for (; i < count; ++i)
+        {
+            std::size_t bit = i * width;
+            const std::uint64_t* p = words + (bit >> 6);
+            std::size_t shift = bit & 63;
+            std::uint64_t value = (p[0] >> shift) | ((p[1] << 1) << (63 - shift));
+            out[i] = (value & mask) + base;
+        }
+    }
+
+#if defined(__CUSTOM_PACKED_AVX2__)
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    bool PackedIntVector<Alloc>::has_avx2()
+    {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    __attribute__((target("avx2")))
+    std::size_t PackedIntVector<Alloc>::unpack_avx2(const unsigned char* bytes, std::uint8_t width,
+                                                    std::uint64_t base, std::size_t count,
+                                                    std::uint64_t* out)
+    {
+        std::uint64_t mask = (std::uint64_t(1) << width) - 1;
+
+        const __m256i vMask = _mm256_set1_epi64x(static_cast<long long>(mask));
+        const __m256i vBase = _mm256_set1_epi64x(static_cast<long long>(base));
+        const __m256i vStep = _mm256_set1_epi64x(static_cast<long long>(4 * width));
+        const __m256i v7 = _mm256_set1_epi64x(7);
+        __m256i bits = _mm256_setr_epi64x(0, width, 2 * width, 3 * width);
+
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256i value = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(bytes),
+                                                   _mm256_srli_epi64(bits, 3), 1);
+            value = _mm256_srlv_epi64(value, _mm256_and_si256(bits, v7));
+            value = _mm256_add_epi64(_mm256_and_si256(value, vMask), vBase);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), value);
+            bits = _mm256_add_epi64(bits, vStep);
+        }
+        return i;
+    }
+#endif
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::uint64_t PackedIntVector<Alloc>::extract(const BlockHeader& header, std::size_t idx) const
+    {
+        if (header.m_width == 0) return 0;
+
+        std::size_t bit = idx * header.m_width;
+        const std::uint64_t* p = m_words.data() + header.m_offset + (bit >> 6);
+        std::size_t shift = bit & 63;
+        std::uint64_t value = (p[0] >> shift) | ((p[1] << 1) << (63 - shift));
+
+        return header.m_width == 64 ? value : value & ((std::uint64_t(1) << header.m_width) - 1);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::uint64_t PackedIntVector<Alloc>::stored_value(const BlockHeader& header,
+                                                       std::uint64_t value) const
+    {
+        switch (m_encoding)
+        {
+        case PackedEncoding::FrameOfReference: return value - header.m_base;
+        case PackedEncoding::Delta: return zigzag(value - m_last);
+        default: return value;
+        }
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    void PackedIntVector<Alloc>::resize_words(std::size_t n)
+    {
+        if (n > m_words.capacity())
+            m_words.reserve(n > m_words.capacity() * 2 ? n : m_words.capacity() * 2);
+
+        m_words.resize(n);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    void PackedIntVector<Alloc>::write_tail(const std::uint64_t* values, std::size_t count)
+    {
+        BlockHeader& header = m_headers.back();
+
+        std::uint64_t minValue = values[0];
+        for (std::size_t i = 1; i < count; ++i)
+            if (values[i] < minValue) minValue = values[i];
+
+        header.m_base = m_encoding == PackedEncoding::FrameOfReference ? minValue
+                        : m_encoding == PackedEncoding::Delta ? values[0] : 0;
+
+        std::uint64_t stored[kBlockSize];
+        std::uint64_t all = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (m_encoding == PackedEncoding::Delta)
+                stored[i] = i ? zigzag(values[i] - values[i - 1]) : 0;
+            else
+                stored[i] = values[i] - header.m_base;
+            all |= stored[i];
+        }
+        header.m_width = bit_width(all);
+
+        resize_words(header.m_offset + 2 * header.m_width + 1);
+        std::uint64_t* words = m_words.data() + header.m_offset;
+        for (std::size_t i = 0; i < 2u * header.m_width; ++i) words[i] = 0;
+
+        for (std::size_t i = 0; i < count && header.m_width; ++i)
+        {
+            std::size_t bit = i * header.m_width;
+            std::size_t shift = bit & 63;
+            words[bit >> 6] |= stored[i] << shift;
+            if (shift + header.m_width > 64) words[(bit >> 6) + 1] |= stored[i] >> (64 - shift);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    PackedIntVector<Alloc>::PackedIntVector(PackedEncoding encoding, const Alloc& alloc)
+        : m_encoding(encoding), m_words(alloc), m_headers(HeaderAlloc(alloc))
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::size_t PackedIntVector<Alloc>::size() const
+    {
+        return m_size;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::size_t PackedIntVector<Alloc>::block_count() const
+    {
+        return m_headers.size();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::size_t PackedIntVector<Alloc>::block_size(std::size_t block) const
+    {
+        return block + 1 < m_headers.size() ? kBlockSize : m_size - block * kBlockSize;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::uint8_t PackedIntVector<Alloc>::block_width(std::size_t block) const
+    {
+        return m_headers[block].m_width;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    PackedEncoding PackedIntVector<Alloc>::encoding() const
+    {
+        return m_encoding;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::size_t PackedIntVector<Alloc>::memory_usage() const
+    {
+        return sizeof(*this) + m_words.capacity() * sizeof(std::uint64_t)
+               + m_headers.capacity() * sizeof(BlockHeader);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::uint64_t PackedIntVector<Alloc>::get(std::size_t i) const
+    {
+        const BlockHeader& header = m_headers[i / kBlockSize];
+        std::size_t idx = i % kBlockSize;
+
+        if (m_encoding != PackedEncoding::Delta) return header.m_base + extract(header, idx);
+
+        std::uint64_t value = header.m_base;
+        for (std::size_t k = 1; k <= idx; ++k) value += unzigzag(extract(header, k));
+        return value;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::uint64_t PackedIntVector<Alloc>::operator [] (std::size_t i) const
+    {
+        return get(i);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::uint64_t PackedIntVector<Alloc>::at(std::size_t i) const
+    {
+        if (i >= size())
+            throw std::out_of_range("Index out of range");
+
+        return get(i);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    void PackedIntVector<Alloc>::push_back(std::uint64_t value)
+    {
+        std::size_t idx = m_size % kBlockSize;
+
+        if (idx == 0)
+        {
+            std::size_t offset = m_words.size() ? m_words.size() - 1 : 0;
+            std::uint64_t base = m_encoding == PackedEncoding::Plain ? 0 : value;
+            m_headers.push_back(BlockHeader{base, offset, 0});
+            resize_words(offset + 1);
+            m_last = value;
+        }
+
+        BlockHeader& header = m_headers.back();
+        std::uint64_t stored = stored_value(header, value);
+
+        bool fits = bit_width(stored) <= header.m_width
+                    && !(m_encoding == PackedEncoding::FrameOfReference && value < header.m_base);
+
+        if (fits && header.m_width)
+        {
+            std::uint64_t* words = m_words.data() + header.m_offset;
+            std::size_t bit = idx * header.m_width;
+            std::size_t shift = bit & 63;
+            words[bit >> 6] |= stored << shift;
+            if (shift + header.m_width > 64) words[(bit >> 6) + 1] |= stored >> (64 - shift);
+        }
+        else if (!fits)
+        {
+            std::uint64_t values[kBlockSize];
+            decode_block(m_headers.size() - 1, values);
+            values[idx] = value;
+            write_tail(values, idx + 1);
+        }
+
+        m_last = value;
+        ++m_size;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    void PackedIntVector<Alloc>::reserve(std::size_t n, std::uint8_t width)
+    {
+        std::size_t blocks = (n + kBlockSize - 1) / kBlockSize;
+        m_headers.reserve(blocks);
+
+        if (!width)
+        {
+            for (std::size_t block = 0; block < m_headers.size(); ++block)
+                if (m_headers[block].m_width > width) width = m_headers[block].m_width;
+        }
+        if (width > 64) width = 64;
+
+        // full blocks keep their words, the tail block may be repacked to the new width
+        std::size_t full = m_size / kBlockSize;
+        if (blocks < full) blocks = full;
+
+        std::size_t used = full < m_headers.size() ? m_headers[full].m_offset
+                                                   : (m_words.size() ? m_words.size() - 1 : 0);
+        m_words.reserve(used + (blocks - full) * 2 * width + 1);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    void PackedIntVector<Alloc>::clear()
+    {
+        m_words.clear();
+        m_headers.clear();
+        m_size = 0;
+        m_last = 0;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    std::size_t PackedIntVector<Alloc>::decode_block(std::size_t block, std::uint64_t* out) const
+    {
+        const BlockHeader& header = m_headers[block];
+        std::size_t count = block_size(block);
+        const std::uint64_t* words = m_words.data() + header.m_offset;
+
+        if (m_encoding != PackedEncoding::Delta)
+        {
+            unpack(words, header.m_width, header.m_base, count, out);
+            return count;
+        }
+
+        unpack(words, header.m_width, 0, count, out);
+        out[0] = header.m_base;
+        for (std::size_t i = 1; i < count; ++i) out[i] = out[i - 1] + unzigzag(out[i]);
+        return count;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename Alloc>
+    template <typename VecAlloc>
+    void PackedIntVector<Alloc>::decode(Vector<std::uint64_t, VecAlloc>& out) const
+    {
+        // decoded straight into spare capacity, nothing is value-initialized first
+        out.resize(0);
+        std::uint64_t* dst = out.spare_capacity(m_size).data();
+        for (std::size_t block = 0; block < m_headers.size(); ++block)
+            dst += decode_block(block, dst);
+
+        out.commit(m_size);
+    }
+};
+
+#endif // __CUSTOM_PACKED_INT_VECTOR__
@@ -0,0 +1,349 @@
+#ifndef __CUSTOM_PARALLEL__
+#define __CUSTOM_PARALLEL__
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include "Vector.hpp"
+#include "ThreadPool.hpp"
+
+namespace custom
+{
+namespace parallel
+{
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // Splits [0, n) into chunks of at least pool.sequential_cutoff() elements and calls
+    // body(begin, end) for each of them on the pool.
+    template <typename Body>
+    void for_range(std::size_t n, Body body, ThreadPool& pool = ThreadPool::default_pool());
+
+    template <typename T, typename Alloc, typename Function>
+    void for_each(Vector<T, Alloc>& vec, Function f,
+                  ThreadPool& pool = ThreadPool::default_pool());
+
+    template <typename T, typename AllocIn, typename U, typename AllocOut, typename Operation>
+    void transform(const Vector<T, AllocIn>& in, Vector<U, AllocOut>& out, Operation op,
+                   ThreadPool& pool = ThreadPool::default_pool());
+
+    template <typename T, typename Alloc, typename U, typename Operation = std::plus<>>
+    U reduce(const Vector<T, Alloc>& vec, U init, Operation op = Operation(),
+             ThreadPool& pool = ThreadPool::default_pool());
+
+    template <typename T, typename Alloc, typename Compare = std::less<T>>
+    void sort(Vector<T, Alloc>& vec, Compare comp = Compare(),
+              ThreadPool& pool = ThreadPool::default_pool());
+
+    template <typename T, typename Alloc, typename Compare = std::less<T>>
+    void stable_sort(Vector<T, Alloc>& vec, Compare comp = Compare(),
+                     ThreadPool& pool = ThreadPool::default_pool());
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    template <typename Body>
+    void for_range(std::size_t n, Body body, ThreadPool& pool)
+    {
+        std::size_t chunk = n / (pool.worker_count() * 4);
+        if (chunk < pool.sequential_cutoff()) chunk = pool.sequential_cutoff();
+
+        if (n <= chunk)
+        {
+            body(std::size_t(0), n);
+            return;
+        }
+
+        TaskGroup group(pool);
+        for (std::size_t begin = chunk; begin < n; begin += chunk)
+        {
+            std::size_t end = n - begin > chunk ? begin + chunk : n;
+            group.run([&body, begin, end] { body(begin, end); });
+        }
+        body(std::size_t(0), chunk);
+        group.wait();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc, typename Function>
+    void for_each(Vector<T, Alloc>& vec, Function f, ThreadPool& pool)
+    {
+        T* data = vec.data();
+        for_range(vec.size(), [data, &f](std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i) f(data[i]);
+        }, pool);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename AllocIn, typename U, typename AllocOut, typename Operation>
+    void transform(const Vector<T, AllocIn>& in, Vector<U, AllocOut>& out, Operation op,
+                   ThreadPool& pool)
+    {
+        using AllocTraits = std::allocator_traits<AllocOut>;
+
+        std::size_t n = in.size();
+        while (out.size() > n) out.pop_back();
+
+        // elements out already has are assigned, the rest is built straight in the spare
+        // capacity by the chunks, so nothing is default-constructed on the calling thread
+        std::size_t old = out.size();
+        out.spare_capacity(n - old);
+
+        const T* src = in.data();
+        U* dst = out.data();
+
+        if (std::is_trivial<U>::value)
+        {
+            for_range(n, [src, dst, &op](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; ++i) dst[i] = op(src[i]);
+            }, pool);
+
+            out.commit(n - old);
+            return;
+        }
+
+        // ranges of the tail that are fully constructed, to be destroyed if a chunk throws
+        AllocOut alloc(out.get_allocator());
+        std::mutex builtMutex;
+        Vector<std::pair<std::size_t, std::size_t>> built;
+        built.reserve(pool.worker_count() * 4 + 1); // upper bound on for_range chunks
+
+        try
+        {
+            for_range(n, [&, src, dst, old](std::size_t begin, std::size_t end)
+            {
+                std::size_t i = begin;
+                for (; i < end && i < old; ++i) dst[i] = op(src[i]);
+
+                std::size_t first = i;
+                try
+                {
+                    for (; i < end; ++i) AllocTraits::construct(alloc, dst + i, op(src[i]));
+                }
+                catch (...)
+                {
+                    for (std::size_t j = first; j < i; ++j) AllocTraits::destroy(alloc, dst + j);
+                    throw;
+                }
+
+                if (first < end)
+                {
+                    std::lock_guard<std::mutex> lock(builtMutex);
+                    built.push_back(std::make_pair(first, end));
+                }
+            }, pool);
+        }
+        catch (...)
+        {
+            for (std::size_t r = 0; r < built.size(); ++r)
+                for (std::size_t j = built[r].first; j < built[r].second; ++j)
+                    AllocTraits::destroy(alloc, dst + j);
+            throw;
+        }
+
+        out.commit(n - old);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc, typename U, typename Operation>
+    U reduce(const Vector<T, Alloc>& vec, U init, Operation op, ThreadPool& pool)
+    {
+        std::size_t n = vec.size();
+        std::size_t chunk = n / (pool.worker_count() * 4);
+        if (chunk < pool.sequential_cutoff()) chunk = pool.sequential_cutoff();
+
+        const T* data = vec.data();
+        if (n <= chunk) return std::accumulate(data, data + n, init, op);
+
+        // every chunk folds into its own partial, partials are combined in order
+        std::size_t chunks = (n + chunk - 1) / chunk;
+        std::unique_ptr<U[]> partials(new U[chunks]);
+        {
+            TaskGroup group(pool);
+            for (std::size_t c = 0; c < chunks; ++c)
+            {
+                group.run([&, c]
+                {
+                    const T* first = data + c * chunk;
+                    const T* last = n - c * chunk > chunk ? first + chunk : data + n;
+                    U acc = *first;
+                    for (++first; first != last; ++first) acc = op(acc, *first);
+                    partials[c] = acc;
+                });
+            }
+            group.wait();
+        }
+
+        for (std::size_t c = 0; c < chunks; ++c) init = op(init, partials[c]);
+        return init;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Compare>
+    void quick_sort(T* first, T* last, Compare comp, ThreadPool& pool, std::size_t depth)
+    {
+        std::size_t cutoff = pool.sequential_cutoff();
+        if (static_cast<std::size_t>(last - first) <= cutoff || depth == 0)
+        {
+            std::sort(first, last, comp);
+            return;
+        }
+
+        // median of three goes to first and serves as the pivot
+        T* mid = first + (last - first) / 2;
+        T* back = last - 1;
+        if (comp(*mid, *first)) std::iter_swap(mid, first);
+        if (comp(*back, *mid)) std::iter_swap(back, mid);
+        if (comp(*mid, *first)) std::iter_swap(mid, first);
+        std::iter_swap(first, mid);
+
+        // three-way partition: [first, lt) < pivot, [lt, gt) == pivot, [gt, last) > pivot;
+        // the pivot copies move along at lt, so *lt is always a pivot value
+        T* lt = first;
+        T* i = first + 1;
+        T* gt = last;
+        while (i < gt)
+        {
+            if (comp(*i, *lt)) std::iter_swap(lt++, i++);
+            else if (comp(*lt, *i)) std::iter_swap(i, --gt);
+            else ++i;
+        }
+
+        TaskGroup group(pool);
+        if (lt - first > 1) group.run([=, &pool] { quick_sort(first, lt, comp, pool, depth - 1); });
+        quick_sort(gt, last, comp, pool, depth - 1);
+        group.wait();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Compare>
+    void merge(T* first1, T* last1, T* first2, T* last2, T* out, Compare comp, ThreadPool& pool)
+    {
+        std::size_t n1 = last1 - first1;
+        std::size_t n2 = last2 - first2;
+        if (n1 + n2 <= pool.sequential_cutoff() || n1 + n2 < 3)
+        {
+            while (first1 != last1 && first2 != last2)
+            {
+                if (comp(*first2, *first1)) *out++ = std::move(*first2++);
+                else *out++ = std::move(*first1++);
+            }
+            std::move(first2, last2, std::move(first1, last1, out));
+            return;
+        }
+
+        // split the longer run in half; equal elements of the first run stay in front
+        T* mid1;
+        T* mid2;
+        if (n1 >= n2)
+        {
+            mid1 = first1 + n1 / 2;
+            mid2 = std::lower_bound(first2, last2, *mid1, comp);
+        }
+        else
+        {
+            mid2 = first2 + n2 / 2;
+            mid1 = std::upper_bound(first1, last1, *mid2, comp);
+        }
+
+        T* outMid = out + (mid1 - first1) + (mid2 - first2);
+
+        TaskGroup group(pool);
+        group.run([=, &pool] { merge(first1, mid1, first2, mid2, out, comp, pool); });
+        merge(mid1, last1, mid2, last2, outMid, comp, pool);
+        group.wait();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc, typename Compare>
+    void sort(Vector<T, Alloc>& vec, Compare comp, ThreadPool& pool)
+    {
+        std::size_t depth = 0;
+        for (std::size_t n = vec.size(); n > 1; n >>= 1) depth += 2;
+
+        quick_sort(vec.data(), vec.data() + vec.size(), comp, pool, depth);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc, typename Compare>
+    void stable_sort(Vector<T, Alloc>& vec, Compare comp, ThreadPool& pool)
+    {
+        using AllocTraits = std::allocator_traits<Alloc>;
+
+        std::size_t n = vec.size();
+        std::size_t chunk = n / (pool.worker_count() * 4);
+        if (chunk < pool.sequential_cutoff()) chunk = pool.sequential_cutoff();
+
+        T* data = vec.data();
+        if (n <= chunk)
+        {
+            std::stable_sort(data, data + n, comp);
+            return;
+        }
+
+        {
+            TaskGroup group(pool);
+            for (std::size_t begin = 0; begin < n; begin += chunk)
+            {
+                std::size_t end = n - begin > chunk ? begin + chunk : n;
+                group.run([=, &comp] { std::stable_sort(data + begin, data + end, comp); });
+            }
+            group.wait();
+        }
+
+        // scratch comes from the vector's own allocator; it is move-constructed from the
+        // sorted runs so both buffers hold live objects and merges can move-assign
+        Alloc alloc(vec.get_allocator());
+        T* scratch = AllocTraits::allocate(alloc, n);
+        try
+        {
+            std::uninitialized_move(data, data + n, scratch);
+        }
+        catch (...)
+        {
+            AllocTraits::deallocate(alloc, scratch, n);
+            throw;
+        }
+
+        struct ScratchGuard
+        {
+            Alloc& m_alloc;
+            T* m_ptr;
+            std::size_t m_n;
+
+            ~ScratchGuard()
+            {
+                for (std::size_t i = 0; i < m_n; ++i) AllocTraits::destroy(m_alloc, m_ptr + i);
+                AllocTraits::deallocate(m_alloc, m_ptr, m_n);
+            }
+        } guard{alloc, scratch, n};
+
+        T* src = scratch;
+        T* dst = data;
+        for (std::size_t width = chunk; width < n; width *= 2)
+        {
+            TaskGroup group(pool);
+            for (std::size_t begin = 0; begin < n; begin += 2 * width)
+            {
+                std::size_t mid = n - begin > width ? begin + width : n;
+                std::size_t end = n - mid > width ? mid + width : n;
+                group.run([=, &comp, &pool]
+                {
+                    merge(src + begin, src + mid, src + mid, src + end, dst + begin, comp, pool);
+                });
+            }
+            group.wait();
+            std::swap(src, dst);
+        }
+
+        if (src != data) std::move(src, src + n, data);
+    }
+};
+};
+
+#endif // __CUSTOM_PARALLEL__
@@ -0,0 +1,16 @@
+#ifndef __CUSTOM_POLY_VECTOR__
+#define __CUSTOM_POLY_VECTOR__
+
+#include "Vector.hpp"
+#include "MemoryResource.hpp"
+
+namespace custom
+{
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // Vector whose storage comes from a MemoryResource picked at runtime, every PolyVector<T>
+    // is the same type whatever resource it uses. Needs src/MemoryResource.cpp.
+    template <typename T>
+    using PolyVector = Vector<T, PolymorphicAllocator<T>>;
+};
+
+#endif // __CUSTOM_POLY_VECTOR__
@@ -0,0 +1,124 @@
+#ifndef __CUSTOM_THREAD_POOL__
+#define __CUSTOM_THREAD_POOL__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace custom
+{
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // Work-stealing pool: every worker owns a deque, pushes and pops its own tasks at the
+    // back and steals from the front of the others when it runs dry. Threads waiting on
+    // a TaskGroup run pending tasks too and park only when there is nothing to take.
+    class ThreadPool
+    {
+    private:
+        struct Queue
+        {
+            std::mutex m_mutex;
+            std::deque<std::function<void()>> m_tasks;
+        };
+
+        std::size_t m_workerCount;
+        std::unique_ptr<Queue[]> m_queues;
+        std::unique_ptr<std::thread[]> m_threads;
+        std::atomic<std::size_t> m_pending{0};
+        std::atomic<std::size_t> m_nextQueue{0};
+        std::atomic<std::size_t> m_cutoff;
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wake;
+        bool m_stop = false;
+
+        void worker_loop(std::size_t index);
+        bool pop_task(std::size_t index, bool steal, std::function<void()>& task);
+
+    public:
+        static constexpr std::size_t kDefaultCutoff = std::size_t(1) << 14;
+
+        explicit ThreadPool(std::size_t workers = std::thread::hardware_concurrency(),
+                            std::size_t cutoff = kDefaultCutoff);
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator = (const ThreadPool&) = delete;
+
+        ~ThreadPool();
+
+        std::size_t worker_count() const;
+        std::size_t sequential_cutoff() const;
+        void set_sequential_cutoff(std::size_t cutoff);
+
+        void submit(std::function<void()> task);
+        bool run_pending_task();
+        bool help_while_waiting();
+
+        static ThreadPool& default_pool();
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    class TaskGroup
+    {
+    private:
+        ThreadPool& m_pool;
+        std::size_t m_active = 0;
+        std::mutex m_mutex;
+        std::condition_variable m_done;
+        std::exception_ptr m_error;
+
+        void finish_task();
+        void wait_tasks();
+
+    public:
+        explicit TaskGroup(ThreadPool& pool);
+
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator = (const TaskGroup&) = delete;
+
+        ~TaskGroup();
+
+        template <typename F>
+        void run(F&& f);
+
+        void wait();
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    template <typename F>
+    void TaskGroup::run(F&& f)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_active;
+        }
+
+        try
+        {
+            m_pool.submit([this, task = std::forward<F>(f)]() mutable
+            {
+                try
+                {
+                    task();
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_error) m_error = std::current_exception();
+                }
+                finish_task();
+            });
+        }
+        catch (...)
+        {
+            finish_task();
+            throw;
+        }
+    }
+};
+
+#endif // __CUSTOM_THREAD_POOL__
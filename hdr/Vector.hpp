@@ -4,6 +4,7 @@
 #include <iterator>
 #include <type_traits>
 #include <memory>
+#include <stdexcept>
 
 namespace custom
 {
@@ -22,17 +23,17 @@ namespace custom
 
     ////////////////////////////////////////////////////////////////////////////////////////
     template <typename Iterator>
-    void advance(Iterator& it, int n)
+    void advance(Iterator& it, typename std::iterator_traits<Iterator>::difference_type n)
     {
-        if constexpr (is_same<typename std::iterator_traits<Iterator>::iterator_category,
-                std::random_access_iterator_tag>::value)
+        if constexpr (std::is_base_of<std::random_access_iterator_tag,
+                typename std::iterator_traits<Iterator>::iterator_category>::value)
         {
             it += n;
         }
         else
         {
-            if (n >= 0) for (int i = 0; i < n; ++i, ++it);
-            else for (int i = n; i > 0; --i, --it);
+            if (n >= 0) for (; n > 0; --n, ++it);
+            else for (; n < 0; ++n, --it);
         }
     }
 
@@ -55,6 +56,13 @@ namespace custom
     template <typename T>
     struct StandartAllocator
     {
+        using value_type = T;
+
+        StandartAllocator() = default;
+
+        template <typename U>
+        StandartAllocator(const StandartAllocator<U>&) {}
+
         T* allocate(size_t n) const;
         void deallocate(T* ptr, size_t) const;
 
@@ -62,10 +70,35 @@ namespace custom
         void construct(T* ptr, const Args&... args) const;
 
         void destroy(T* ptr) const;
-    };    
+    };
+
+    template <typename T, typename U>
+    bool operator == (const StandartAllocator<T>&, const StandartAllocator<U>&);
+
+    template <typename T, typename U>
+    bool operator != (const StandartAllocator<T>&, const StandartAllocator<U>&);
+
     // FixedAllocator
     // PoolAllocator
 
+    ////////////////////////////////////////////////////////////////////////////////////////
+    template <typename T>
+    class Span
+    {
+    private:
+        T* m_data;
+        std::size_t m_size;
+
+    public:
+        Span(T* data, std::size_t size);
+
+        T* data() const;
+        std::size_t size() const;
+        T& operator [] (std::size_t i) const;
+        T* begin() const;
+        T* end() const;
+    };
+
     ////////////////////////////////////////////////////////////////////////////////////////
     template <typename T, typename Alloc = StandartAllocator<T>>
     struct VectorBase
@@ -77,13 +110,17 @@ namespace custom
 
         using AllocTraits = std::allocator_traits<Alloc>;
 
-        VectorBase(const Alloc alloc, std::size_t n)
+        VectorBase(const Alloc& alloc)
+            : m_alloc(alloc), m_start(nullptr), m_end(nullptr), m_spaceEnd(nullptr)
+        {}
+
+        VectorBase(const Alloc& alloc, std::size_t n)
             : m_alloc(alloc), m_start(AllocTraits::allocate(m_alloc, n)),
               m_end(m_start), m_spaceEnd(m_start + n)
         {}
 
         void free_memory() 
-        { AllocTraits::deallocate(m_alloc, m_start, m_spaceEnd - m_start); }
+        { if (m_start) AllocTraits::deallocate(m_alloc, m_start, m_spaceEnd - m_start); }
 
         ~VectorBase()
         { free_memory(); }
@@ -117,19 +154,57 @@ namespace custom
         private:
             conditional_t<IsConst, const T*, T*> m_ptr = nullptr;
 
-        public:
-            common_iterator(T* ptr);
+            template <bool>
+            friend class common_iterator;
 
-            conditional_t<IsConst, const T&, T&> operator * () const;
-            conditional_t<IsConst, const T*, T*> operator -> () const;
+        public:
+#if __cplusplus >= 202002L
+            using iterator_concept = std::contiguous_iterator_tag;
+#endif
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = conditional_t<IsConst, const T*, T*>;
+            using reference = conditional_t<IsConst, const T&, T&>;
+
+            common_iterator() = default;
+            common_iterator(pointer ptr);
+
+            // iterator -> const_iterator
+            template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+            common_iterator(const common_iterator<OtherConst>& other);
+
+            reference operator * () const;
+            pointer operator -> () const;
+            reference operator [] (difference_type n) const;
             common_iterator<IsConst>& operator ++ ();
             common_iterator<IsConst>& operator -- ();
-            common_iterator<IsConst>& operator += (std::size_t n);
-            common_iterator<IsConst>& operator -= (std::size_t n);
+            common_iterator<IsConst>& operator += (difference_type n);
+            common_iterator<IsConst>& operator -= (difference_type n);
             common_iterator<IsConst> operator ++ (int);
             common_iterator<IsConst> operator -- (int);
-            common_iterator<IsConst> operator - (std::size_t n);
-            common_iterator<IsConst> operator + (std::size_t n);
+            common_iterator<IsConst> operator - (difference_type n) const;
+            common_iterator<IsConst> operator + (difference_type n) const;
+
+            template <bool OtherConst>
+            difference_type operator - (const common_iterator<OtherConst>& other) const;
+
+            template <bool OtherConst>
+            bool operator == (const common_iterator<OtherConst>& other) const;
+            template <bool OtherConst>
+            bool operator != (const common_iterator<OtherConst>& other) const;
+            template <bool OtherConst>
+            bool operator < (const common_iterator<OtherConst>& other) const;
+            template <bool OtherConst>
+            bool operator > (const common_iterator<OtherConst>& other) const;
+            template <bool OtherConst>
+            bool operator <= (const common_iterator<OtherConst>& other) const;
+            template <bool OtherConst>
+            bool operator >= (const common_iterator<OtherConst>& other) const;
+
+            friend common_iterator<IsConst> operator + (difference_type n,
+                                                       const common_iterator<IsConst>& it)
+            { return it + n; }
         };
 
         using iterator = common_iterator<false>;
@@ -143,15 +218,18 @@ namespace custom
                const Alloc& alloc = Alloc());
 
         Vector(const Vector<T, Alloc>& vec);
-        Vector(Vector<T, Alloc>&& vec); //
+        Vector(Vector<T, Alloc>&& vec) noexcept;
+        ~Vector();
 
         Vector<T, Alloc>& operator = (const Vector<T, Alloc>& vec);
-        Vector<T, Alloc>& operator = (Vector<T, Alloc>&& vec); //
+        Vector<T, Alloc>& operator = (Vector<T, Alloc>&& vec)
+            noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                     || AllocTraits::is_always_equal::value);
         void safe_assign(const Vector<T, Alloc>& vec);
 
         std::size_t size() const;
         std::size_t capacity() const;
-        const Alloc& get_allocator() const; //
+        const Alloc& get_allocator() const;
 
         void resize(std::size_t n, T value = T());
         void reserve(std::size_t n);
@@ -175,6 +253,12 @@ namespace custom
         T* data();
         T const * data() const;
 
+        // raw storage between end() and the end of capacity, for filling in place;
+        // commit(n) turns the first n elements of it into part of the vector. Trivial
+        // types can simply be written, anything else has to be constructed there first
+        Span<T> spare_capacity(std::size_t atLeast = 0);
+        void commit(std::size_t n);
+
         T& front();
         const T& front() const;
         T& back();
@@ -295,7 +379,7 @@ namespace custom
     template <typename T>
     T* StandartAllocator<T>::allocate(size_t n) const
     {
-        return ::operator new(n * sizeof(T));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
     }
 
     // ---------------------------------------------------------------------------------- //
@@ -320,14 +404,78 @@ namespace custom
         ptr->~T();
     }
 
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename U>
+    bool operator == (const StandartAllocator<T>&, const StandartAllocator<U>&)
+    {
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename U>
+    bool operator != (const StandartAllocator<T>&, const StandartAllocator<U>&)
+    {
+        return false;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    Span<T>::Span(T* data, std::size_t size)
+        : m_data(data), m_size(size)
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    T* Span<T>::data() const
+    {
+        return m_data;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    std::size_t Span<T>::size() const
+    {
+        return m_size;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    T& Span<T>::operator [] (std::size_t i) const
+    {
+        return m_data[i];
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    T* Span<T>::begin() const
+    {
+        return m_data;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T>
+    T* Span<T>::end() const
+    {
+        return m_data + m_size;
+    }
+
     ////////////////////////////////////////////////////////////////////////////////////////
     // ---------------------------------------------------------------------------------- //
     template <typename T, typename Alloc>
     template <bool IsConst>
-    Vector<T, Alloc>::common_iterator<IsConst>::common_iterator(T* ptr)
+    Vector<T, Alloc>::common_iterator<IsConst>::common_iterator(pointer ptr)
         : m_ptr(ptr)
     {}
 
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    template <bool IsConst>
+    template <bool OtherConst, typename>
+    Vector<T, Alloc>::common_iterator<IsConst>::common_iterator(const common_iterator<OtherConst>& other)
+        : m_ptr(other.m_ptr)
+    {}
+
     // ---------------------------------------------------------------------------------- //
     template <typename T, typename Alloc>
     template <bool IsConst>
@@ -346,6 +494,15 @@ namespace custom
         return m_ptr;
     }
 
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    template <bool IsConst>
+    conditional_t<IsConst, const T&, T&>
+    Vector<T, Alloc>::common_iterator<IsConst>::operator [] (difference_type n) const
+    {
+        return m_ptr[n];
+    }
+
     // ---------------------------------------------------------------------------------- //
     template <typename T, typename Alloc>
     template <bool IsConst>
@@ -388,7 +545,7 @@ namespace custom
     template <typename T, typename Alloc>
     template <bool IsConst>
     typename Vector<T, Alloc>::template common_iterator<IsConst>&
-    Vector<T, Alloc>::common_iterator<IsConst>::operator += (std::size_t n)
+    Vector<T, Alloc>::common_iterator<IsConst>::operator += (difference_type n)
     {
         m_ptr += n;
         return *this;
@@ -398,7 +555,7 @@ namespace custom
     template <typename T, typename Alloc>
     template <bool IsConst>
     typename Vector<T, Alloc>::template common_iterator<IsConst>&
-    Vector<T, Alloc>::common_iterator<IsConst>::operator -= (std::size_t n)
+    Vector<T, Alloc>::common_iterator<IsConst>::operator -= (difference_type n)
     {
         m_ptr -= n;
         return *this;
@@ -408,20 +565,82 @@ namespace custom
     template <typename T, typename Alloc>
     template <bool IsConst>
     typename Vector<T, Alloc>::template common_iterator<IsConst>
-    Vector<T, Alloc>::common_iterator<IsConst>::operator - (std::size_t n)
+    Vector<T, Alloc>::common_iterator<IsConst>::operator - (difference_type n) const
     {
-        auto copy(*this);
-        return copy += n;
+        return common_iterator<IsConst>(m_ptr - n);
     }
 
     // ---------------------------------------------------------------------------------- //
     template <typename T, typename Alloc>
     template <bool IsConst>
     typename Vector<T, Alloc>::template common_iterator<IsConst>
-    Vector<T, Alloc>::common_iterator<IsConst>::operator + (std::size_t n)
+    Vector<T, Alloc>::common_iterator<IsConst>::operator + (difference_type n) const
+    {
+        return common_iterator<IsConst>(m_ptr + n);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    template <bool IsConst>
+    template <bool OtherConst>
+    std::ptrdiff_t
+    Vector<T, Alloc>::common_iterator<IsConst>::operator - (const common_iterator<OtherConst>& other) const
+    {
+        return m_ptr - other.m_ptr;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    template <bool IsConst>
+    template <bool OtherConst>
+    bool Vector<T, Alloc>::common_iterator<IsConst>::operator == (const common_iterator<OtherConst>& other) const
+    {
+        return m_ptr == other.m_ptr;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    template <bool IsConst>
+    template <bool OtherConst>
+    bool Vector<T, Alloc>::common_iterator<IsConst>::operator != (const common_iterator<OtherConst>& other) const
+    {
+        return m_ptr != other.m_ptr;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    template <bool IsConst>
+    template <bool OtherConst>
+    bool Vector<T, Alloc>::common_iterator<IsConst>::operator < (const common_iterator<OtherConst>& other) const
     {
-        auto copy(*this);
-        return copy -= n;
+        return m_ptr < other.m_ptr;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    template <bool IsConst>
+    template <bool OtherConst>
+    bool Vector<T, Alloc>::common_iterator<IsConst>::operator > (const common_iterator<OtherConst>& other) const
+    {
+        return m_ptr > other.m_ptr;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    template <bool IsConst>
+    template <bool OtherConst>
+    bool Vector<T, Alloc>::common_iterator<IsConst>::operator <= (const common_iterator<OtherConst>& other) const
+    {
+        return m_ptr <= other.m_ptr;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    template <bool IsConst>
+    template <bool OtherConst>
+    bool Vector<T, Alloc>::common_iterator<IsConst>::operator >= (const common_iterator<OtherConst>& other) const
+    {
+        return m_ptr >= other.m_ptr;
     }
 
     
@@ -436,7 +655,7 @@ namespace custom
     // ---------------------------------------------------------------------------------- //
     template <typename T, typename Alloc>
     Vector<T, Alloc>::Vector(const Alloc& alloc)
-        : VectorBase<T, Alloc>(alloc, 0)
+        : VectorBase<T, Alloc>(alloc)
     {}
 
     // ---------------------------------------------------------------------------------- //
@@ -451,7 +670,8 @@ namespace custom
     // ---------------------------------------------------------------------------------- //
     template <typename T, typename Alloc>
     Vector<T, Alloc>::Vector(const Vector<T, Alloc>& vec)
-        : VectorBase<T, Alloc>(vec.alloc, vec.capacity())
+        : VectorBase<T, Alloc>(
+              AllocTraits::select_on_container_copy_construction(vec.m_alloc), vec.capacity())
     {
         std::uninitialized_copy(vec.m_start, vec.m_end, m_start);
         m_end = m_start + vec.size();
@@ -459,14 +679,27 @@ namespace custom
 
     // ---------------------------------------------------------------------------------- //
     template <typename T, typename Alloc>
-    Vector<T, Alloc>::Vector(Vector<T, Alloc>&& vec) {}
+    Vector<T, Alloc>::Vector(Vector<T, Alloc>&& vec) noexcept
+        : VectorBase<T, Alloc>(vec.m_alloc)
+    {
+        std::swap(m_start, vec.m_start);
+        std::swap(m_end, vec.m_end);
+        std::swap(m_spaceEnd, vec.m_spaceEnd);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    Vector<T, Alloc>::~Vector()
+    {
+        destroy_elements();
+    }
 
     // ---------------------------------------------------------------------------------- //
     template <typename T, typename Alloc>
     Vector<T, Alloc>& Vector<T, Alloc>::operator = (const Vector<T, Alloc>& vec)
     {
-        if (AllocTraits::propagate_on_container_copy_assignment::value
-            || (capacity() < vec.size()))
+        if ((AllocTraits::propagate_on_container_copy_assignment::value
+             && m_alloc != vec.m_alloc) || (capacity() < vec.size()))
         {
             safe_assign(vec);
             return *this;
@@ -475,6 +708,9 @@ namespace custom
         {
             if (this == &vec) return *this; 
 
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value)
+                m_alloc = vec.m_alloc;
+
             std::size_t sz = size();
             std::size_t vecSz = vec.size();
 
@@ -494,33 +730,57 @@ namespace custom
         }
     }
 
-    //template <typename T, typename Alloc>
-    //Vector<T, Alloc>& operator = (Vector<T, Alloc>&& vec); //
-
     // ---------------------------------------------------------------------------------- //
     template <typename T, typename Alloc>
-    void Vector<T, Alloc>::safe_assign(const Vector<T, Alloc>& vec)
+    Vector<T, Alloc>& Vector<T, Alloc>::operator = (Vector<T, Alloc>&& vec)
+        noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                 || AllocTraits::is_always_equal::value)
     {
-        if (this == &vec) return;
+        if (this == &vec) return *this;
 
-        if (AllocTraits::propagate_on_container_copy_assignment::value
-            && m_alloc != vec.m_alloc)
+        if (AllocTraits::propagate_on_container_move_assignment::value
+            || m_alloc == vec.m_alloc)
         {
-            Vector<T, Alloc> temp(vec);
-            swap<VectorBase<T, Alloc>>(temp, *this);
+            destroy_elements();
+            VectorBase<T, Alloc>::free_memory();
+
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value)
+                m_alloc = std::move(vec.m_alloc);
+
+            m_start = vec.m_start;
+            m_end = vec.m_end;
+            m_spaceEnd = vec.m_spaceEnd;
+            vec.m_start = vec.m_end = vec.m_spaceEnd = nullptr;
         }
         else
         {
-            T* newStart = AllocTraits::allocate(m_alloc, vec.capacity());
-            std::uninitialized_copy(m_start, m_end, newStart);
-            
-            destroy_elements();
-            VectorBase<T, Alloc>::free_memory();
+            // storage of vec belongs to a foreign arena, so only elements can move
+            VectorBase<T, Alloc> temp(m_alloc, vec.size());
+            std::uninitialized_move(vec.m_start, vec.m_end, temp.m_start);
+            temp.m_end = temp.m_start + vec.size();
 
-            m_start = newStart;
-            m_end = m_start + vec.size();
-            m_spaceEnd = m_start + vec.capacity();
+            destroy_elements();
+            swap<T, Alloc>(temp, *this);
         }
+        return *this;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    void Vector<T, Alloc>::safe_assign(const Vector<T, Alloc>& vec)
+    {
+        if (this == &vec) return;
+
+        bool propagate = AllocTraits::propagate_on_container_copy_assignment::value
+                         && m_alloc != vec.m_alloc;
+
+        VectorBase<T, Alloc> temp(propagate ? vec.m_alloc : m_alloc, vec.capacity());
+        std::uninitialized_copy(vec.m_start, vec.m_end, temp.m_start);
+        temp.m_end = temp.m_start + vec.size();
+
+        // old elements are destroyed here, temp frees their storage with the old allocator
+        destroy_elements();
+        swap<T, Alloc>(temp, *this);
     }
 
     // ---------------------------------------------------------------------------------- //
@@ -536,6 +796,13 @@ namespace custom
     {
         return m_spaceEnd - m_start;
     }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    const Alloc& Vector<T, Alloc>::get_allocator() const
+    {
+        return m_alloc;
+    }
     
     // ---------------------------------------------------------------------------------- //
     template <typename T, typename Alloc>
@@ -564,22 +831,22 @@ namespace custom
         temp.m_end = temp.m_start + size();
 
         destroy_elements(); // can delete call becouse there already is in temp destructor
-        swap<VectorBase<T, Alloc>>(temp, *this);
+        swap<T, Alloc>(temp, *this);
     }
 
     // ---------------------------------------------------------------------------------- //
     template <typename T, typename Alloc>
     void Vector<T, Alloc>::shrink_to_fit()
     {
-        T* newStart = AllocTraits::allocate(m_alloc, size());
-        std::uninitialized_copy(m_start, m_end, newStart);
-        
-        destroy_elements();
-        VectorBase<T, Alloc>::free_memory();
+        if (m_end == m_spaceEnd) return;
 
-        m_start = newStart;
-        m_end = m_start + size();
-        m_spaceEnd = m_end;
+        std::size_t sz = size();
+        VectorBase<T, Alloc> temp(m_alloc, sz);
+        std::uninitialized_copy(m_start, m_end, temp.m_start);
+        temp.m_end = temp.m_start + sz;
+
+        destroy_elements();
+        swap<T, Alloc>(temp, *this);
     }
 
     // ---------------------------------------------------------------------------------- //
@@ -631,6 +898,26 @@ namespace custom
         return m_start;
     }
 
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    Span<T> Vector<T, Alloc>::spare_capacity(std::size_t atLeast)
+    {
+        if (static_cast<std::size_t>(m_spaceEnd - m_end) < atLeast)
+            reserve(size() + atLeast > capacity() * 2 ? size() + atLeast : capacity() * 2);
+
+        return Span<T>(m_end, m_spaceEnd - m_end);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    void Vector<T, Alloc>::commit(std::size_t n)
+    {
+        if (n > static_cast<std::size_t>(m_spaceEnd - m_end))
+            throw std::length_error("Commit exceeds capacity");
+
+        m_end += n;
+    }
+
     // ---------------------------------------------------------------------------------- //
     template <typename T, typename Alloc>
     T& Vector<T, Alloc>::front()
@@ -730,7 +1017,7 @@ namespace custom
     typename Vector<T, Alloc>::reverse_iterator
     Vector<T, Alloc>::rbegin() const
     {
-        return reverse_iterator(m_end - 1);
+        return reverse_iterator(end());
     }
 
     // ---------------------------------------------------------------------------------- //
@@ -738,7 +1025,7 @@ namespace custom
     typename Vector<T, Alloc>::reverse_iterator
     Vector<T, Alloc>::rend() const
     {
-        return reverse_iterator(m_start - 1);
+        return reverse_iterator(begin());
     }
 
     // ---------------------------------------------------------------------------------- //
@@ -746,7 +1033,7 @@ namespace custom
     typename Vector<T, Alloc>::const_reverse_iterator
     Vector<T, Alloc>::rcbegin() const
     {
-        return const_reverse_iterator(m_end - 1);
+        return const_reverse_iterator(cend());
     }
 
     // ---------------------------------------------------------------------------------- //
@@ -754,7 +1041,7 @@ namespace custom
     typename Vector<T, Alloc>::const_reverse_iterator
     Vector<T, Alloc>::rcend() const
     {
-        return const_reverse_iterator(m_start - 1);
+        return const_reverse_iterator(cbegin());
     }
 };
 
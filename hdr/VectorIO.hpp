@@ -0,0 +1,124 @@
+#ifndef __CUSTOM_VECTOR_IO__
+#define __CUSTOM_VECTOR_IO__
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <type_traits>
+#include <unistd.h>
+#include "Vector.hpp"
+
+namespace custom
+{
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // POSIX I/O straight into and out of Vector storage of bytes (char, unsigned char,
+    // std::byte). Results follow read/readv/write: bytes transferred, 0 on end of file,
+    // -1 with errno set; EINTR is retried.
+    constexpr std::size_t kReadvExtraSize = 64 * 1024;
+
+    template <typename T>
+    struct is_io_byte : std::integral_constant<bool,
+        std::is_same<T, char>::value || std::is_same<T, unsigned char>::value
+        || std::is_same<T, std::byte>::value>
+    {};
+
+    // reads at most max bytes into the spare capacity, growing it if needed;
+    // max == 0 fails with EINVAL, so 0 always means end of file
+    template <typename T, typename Alloc>
+    ssize_t read_from(int fd, Vector<T, Alloc>& vec, std::size_t max);
+
+    // makes sure at least minSpare bytes of spare capacity exist, then reads into them
+    // plus a stack buffer of kReadvExtraSize with one readv call; the stack buffer is
+    // copied from only when a read is larger than the spare capacity
+    template <typename T, typename Alloc>
+    ssize_t readv_from(int fd, Vector<T, Alloc>& vec, std::size_t minSpare = kReadvExtraSize);
+
+    // writes data()[offset, size()) and keeps writing after partial writes
+    template <typename T, typename Alloc>
+    ssize_t write_to(int fd, const Vector<T, Alloc>& vec, std::size_t offset = 0);
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    ssize_t read_from(int fd, Vector<T, Alloc>& vec, std::size_t max)
+    {
+        static_assert(is_io_byte<T>::value, "only byte vectors can be filled from a descriptor");
+
+        if (max == 0)
+        {
+            errno = EINVAL;
+            return -1;
+        }
+
+        Span<T> spare = vec.spare_capacity(max);
+
+        ssize_t n;
+        do n = ::read(fd, spare.data(), max);
+        while (n < 0 && errno == EINTR);
+
+        if (n > 0) vec.commit(n);
+        return n;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    ssize_t readv_from(int fd, Vector<T, Alloc>& vec, std::size_t minSpare)
+    {
+        static_assert(is_io_byte<T>::value, "only byte vectors can be filled from a descriptor");
+
+        char extra[kReadvExtraSize];
+        Span<T> spare = vec.spare_capacity(minSpare);
+
+        iovec iov[2];
+        iov[0].iov_base = spare.data();
+        iov[0].iov_len = spare.size();
+        iov[1].iov_base = extra;
+        iov[1].iov_len = sizeof(extra);
+
+        ssize_t n;
+        do n = ::readv(fd, iov, 2);
+        while (n < 0 && errno == EINTR);
+
+        if (n <= 0) return n;
+
+        if (static_cast<std::size_t>(n) <= spare.size())
+        {
+            vec.commit(n);
+            return n;
+        }
+
+        vec.commit(spare.size());
+        std::size_t rest = n - spare.size();
+        std::memcpy(vec.spare_capacity(rest).data(), extra, rest);
+        vec.commit(rest);
+        return n;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    template <typename T, typename Alloc>
+    ssize_t write_to(int fd, const Vector<T, Alloc>& vec, std::size_t offset)
+    {
+        static_assert(is_io_byte<T>::value, "only byte vectors can be written to a descriptor");
+
+        if (offset >= vec.size()) return 0;
+
+        const T* data = vec.data();
+        std::size_t written = offset;
+        while (written < vec.size())
+        {
+            ssize_t n = ::write(fd, data + written, vec.size() - written);
+            if (n < 0)
+            {
+                if (errno == EINTR) continue;
+                if (written == offset) return -1;
+                break;
+            }
+            written += n;
+        }
+        return written - offset;
+    }
+};
+
+#endif // __CUSTOM_VECTOR_IO__
@@ -0,0 +1,407 @@
+#include <MemoryResource.hpp>
+#include <atomic>
+#include <memory>
+
+namespace custom
+{
+    namespace
+    {
+        constexpr std::size_t kDefaultChunkSize = 1024;
+        constexpr std::size_t kDefaultBlocksPerChunk = 1024;
+        constexpr std::size_t kDefaultLargestBlock = 4096;
+        constexpr std::size_t kMaxLargestBlock = std::size_t(1) << 20;
+        constexpr std::size_t kInitialBlocksPerChunk = 8;
+
+        ////////////////////////////////////////////////////////////////////////////////////
+        class NewDeleteResource : public MemoryResource
+        {
+            void* do_allocate(std::size_t bytes, std::size_t align) override
+            {
+                return ::operator new(bytes, std::align_val_t(align));
+            }
+
+            void do_deallocate(void* ptr, std::size_t, std::size_t align) override
+            {
+                ::operator delete(ptr, std::align_val_t(align));
+            }
+
+            bool do_is_equal(const MemoryResource& other) const noexcept override
+            {
+                return this == &other;
+            }
+        };
+
+        ////////////////////////////////////////////////////////////////////////////////////
+        class NullMemoryResource : public MemoryResource
+        {
+            void* do_allocate(std::size_t, std::size_t) override
+            {
+                throw std::bad_alloc();
+            }
+
+            void do_deallocate(void*, std::size_t, std::size_t) override
+            {}
+
+            bool do_is_equal(const MemoryResource& other) const noexcept override
+            {
+                return this == &other;
+            }
+        };
+
+        std::atomic<MemoryResource*>& default_resource()
+        {
+            static std::atomic<MemoryResource*> resource(new_delete_resource());
+            return resource;
+        }
+
+        std::size_t round_up(std::size_t n, std::size_t align)
+        {
+            return (n + align - 1) & ~(align - 1);
+        }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    void* MemoryResource::allocate(std::size_t bytes, std::size_t align)
+    {
+        return do_allocate(bytes, align);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void MemoryResource::deallocate(void* ptr, std::size_t bytes, std::size_t align)
+    {
+        do_deallocate(ptr, bytes, align);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    bool MemoryResource::is_equal(const MemoryResource& other) const noexcept
+    {
+        return do_is_equal(other);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    bool operator == (const MemoryResource& a, const MemoryResource& b) noexcept
+    {
+        return &a == &b || a.is_equal(b);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    bool operator != (const MemoryResource& a, const MemoryResource& b) noexcept
+    {
+        return !(a == b);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    MemoryResource* new_delete_resource() noexcept
+    {
+        static NewDeleteResource resource;
+        return &resource;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    MemoryResource* null_memory_resource() noexcept
+    {
+        static NullMemoryResource resource;
+        return &resource;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    MemoryResource* get_default_resource() noexcept
+    {
+        return default_resource().load();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    MemoryResource* set_default_resource(MemoryResource* resource) noexcept
+    {
+        if (!resource) resource = new_delete_resource();
+        return default_resource().exchange(resource);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    MonotonicBufferResource::MonotonicBufferResource(MemoryResource* upstream)
+        : MonotonicBufferResource(kDefaultChunkSize, upstream)
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    MonotonicBufferResource::MonotonicBufferResource(std::size_t initialSize,
+                                                     MemoryResource* upstream)
+        : m_upstream(upstream), m_initialBuffer(nullptr), m_initialSize(0),
+          m_current(nullptr), m_left(0), m_nextSize(initialSize ? initialSize : 1)
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    MonotonicBufferResource::MonotonicBufferResource(void* buffer, std::size_t size,
+                                                     MemoryResource* upstream)
+        : m_upstream(upstream), m_initialBuffer(buffer), m_initialSize(size),
+          m_current(static_cast<char*>(buffer)), m_left(size),
+          m_nextSize(size ? size * 2 : kDefaultChunkSize)
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    MonotonicBufferResource::~MonotonicBufferResource()
+    {
+        release();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void MonotonicBufferResource::release()
+    {
+        while (m_chunks)
+        {
+            Chunk* next = m_chunks->m_next;
+            char* base = reinterpret_cast<char*>(m_chunks + 1) - m_chunks->m_size;
+            m_upstream->deallocate(base, m_chunks->m_size, m_chunks->m_align);
+            m_chunks = next;
+        }
+
+        m_current = static_cast<char*>(m_initialBuffer);
+        m_left = m_initialSize;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    MemoryResource* MonotonicBufferResource::upstream_resource() const
+    {
+        return m_upstream;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void* MonotonicBufferResource::do_allocate(std::size_t bytes, std::size_t align)
+    {
+        void* ptr = m_current;
+        if (ptr && std::align(align, bytes, ptr, m_left))
+        {
+            m_current = static_cast<char*>(ptr) + bytes;
+            m_left -= bytes;
+            return ptr;
+        }
+
+        // Chunk header lives behind the usable area so the area itself starts aligned.
+        std::size_t usable = round_up(bytes > m_nextSize ? bytes : m_nextSize, alignof(Chunk));
+        std::size_t total = usable + sizeof(Chunk);
+        std::size_t chunkAlign = align > alignof(std::max_align_t)
+                                 ? align : alignof(std::max_align_t);
+
+        char* base = static_cast<char*>(m_upstream->allocate(total, chunkAlign));
+        m_chunks = new (base + usable) Chunk{m_chunks, total, chunkAlign};
+        m_nextSize = usable * 2;
+
+        m_current = base + bytes;
+        m_left = usable - bytes;
+        return base;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void MonotonicBufferResource::do_deallocate(void*, std::size_t, std::size_t)
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    bool MonotonicBufferResource::do_is_equal(const MemoryResource& other) const noexcept
+    {
+        return this == &other;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    UnsynchronizedPoolResource::UnsynchronizedPoolResource(MemoryResource* upstream)
+        : UnsynchronizedPoolResource(PoolOptions(), upstream)
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    UnsynchronizedPoolResource::UnsynchronizedPoolResource(const PoolOptions& options,
+                                                           MemoryResource* upstream)
+        : m_upstream(upstream), m_options(options)
+    {
+        if (!m_options.max_blocks_per_chunk)
+            m_options.max_blocks_per_chunk = kDefaultBlocksPerChunk;
+
+        std::size_t largest = m_options.largest_required_pool_block;
+        if (!largest) largest = kDefaultLargestBlock;
+        if (largest > kMaxLargestBlock) largest = kMaxLargestBlock;
+
+        std::size_t blockSize = kMinBlock;
+        for (; m_poolCount < kMaxPools; blockSize *= 2)
+        {
+            m_pools[m_poolCount].m_blockSize = blockSize;
+            m_pools[m_poolCount].m_nextBlocks = kInitialBlocksPerChunk;
+            ++m_poolCount;
+            if (blockSize >= largest) break;
+        }
+        m_options.largest_required_pool_block = m_pools[m_poolCount - 1].m_blockSize;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    UnsynchronizedPoolResource::~UnsynchronizedPoolResource()
+    {
+        release();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void UnsynchronizedPoolResource::release()
+    {
+        for (std::size_t i = 0; i < m_poolCount; ++i)
+        {
+            Pool& pool = m_pools[i];
+            while (pool.m_chunks)
+            {
+                Chunk* next = pool.m_chunks->m_next;
+                char* base = reinterpret_cast<char*>(pool.m_chunks + 1) - pool.m_chunks->m_size;
+                m_upstream->deallocate(base, pool.m_chunks->m_size, pool.m_chunks->m_align);
+                pool.m_chunks = next;
+            }
+            pool.m_free = nullptr;
+            pool.m_nextBlocks = kInitialBlocksPerChunk;
+        }
+
+        while (m_large)
+        {
+            LargeBlock* next = m_large->m_next;
+            char* base = reinterpret_cast<char*>(m_large + 1) - m_large->m_offset;
+            m_upstream->deallocate(base, m_large->m_size, m_large->m_align);
+            m_large = next;
+        }
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    MemoryResource* UnsynchronizedPoolResource::upstream_resource() const
+    {
+        return m_upstream;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    PoolOptions UnsynchronizedPoolResource::options() const
+    {
+        return m_options;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    UnsynchronizedPoolResource::Pool*
+    UnsynchronizedPoolResource::find_pool(std::size_t bytes, std::size_t align)
+    {
+        std::size_t size = bytes > align ? bytes : align;
+        for (std::size_t i = 0; i < m_poolCount; ++i)
+            if (size <= m_pools[i].m_blockSize) return &m_pools[i];
+
+        return nullptr;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void UnsynchronizedPoolResource::refill(Pool& pool)
+    {
+        std::size_t blocks = pool.m_nextBlocks;
+        std::size_t usable = blocks * pool.m_blockSize;
+        std::size_t total = usable + sizeof(Chunk);
+        std::size_t chunkAlign = pool.m_blockSize > alignof(std::max_align_t)
+                                 ? pool.m_blockSize : alignof(std::max_align_t);
+
+        char* base = static_cast<char*>(m_upstream->allocate(total, chunkAlign));
+        pool.m_chunks = new (base + usable) Chunk{pool.m_chunks, total, chunkAlign};
+
+        for (std::size_t i = blocks; i > 0; --i)
+            pool.m_free = new (base + (i - 1) * pool.m_blockSize) FreeBlock{pool.m_free};
+
+        if (blocks * 2 <= m_options.max_blocks_per_chunk) pool.m_nextBlocks = blocks * 2;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void* UnsynchronizedPoolResource::do_allocate(std::size_t bytes, std::size_t align)
+    {
+        if (Pool* pool = find_pool(bytes, align))
+        {
+            if (!pool->m_free) refill(*pool);
+
+            FreeBlock* block = pool->m_free;
+            pool->m_free = block->m_next;
+            return block;
+        }
+
+        // the header is padded up to the alignment so the block after it stays aligned
+        std::size_t blockAlign = align > alignof(LargeBlock) ? align : alignof(LargeBlock);
+        std::size_t offset = (sizeof(LargeBlock) + blockAlign - 1) / blockAlign * blockAlign;
+        if (bytes > std::size_t(-1) - offset) throw std::bad_alloc();
+        std::size_t total = offset + bytes;
+
+        char* base = static_cast<char*>(m_upstream->allocate(total, blockAlign));
+        LargeBlock* node = new (base + offset - sizeof(LargeBlock))
+            LargeBlock{nullptr, m_large, offset, total, blockAlign};
+
+        if (m_large) m_large->m_prev = node;
+        m_large = node;
+        return base + offset;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void UnsynchronizedPoolResource::do_deallocate(void* ptr, std::size_t bytes, std::size_t align)
+    {
+        if (Pool* pool = find_pool(bytes, align))
+        {
+            pool->m_free = new (ptr) FreeBlock{pool->m_free};
+            return;
+        }
+
+        LargeBlock* node = static_cast<LargeBlock*>(ptr) - 1;
+        if (node->m_prev) node->m_prev->m_next = node->m_next;
+        else m_large = node->m_next;
+        if (node->m_next) node->m_next->m_prev = node->m_prev;
+
+        m_upstream->deallocate(static_cast<char*>(ptr) - node->m_offset, node->m_size, node->m_align);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    bool UnsynchronizedPoolResource::do_is_equal(const MemoryResource& other) const noexcept
+    {
+        return this == &other;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    SynchronizedPoolResource::SynchronizedPoolResource(MemoryResource* upstream)
+        : m_pool(upstream)
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    SynchronizedPoolResource::SynchronizedPoolResource(const PoolOptions& options,
+                                                       MemoryResource* upstream)
+        : m_pool(options, upstream)
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    void SynchronizedPoolResource::release()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pool.release();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    MemoryResource* SynchronizedPoolResource::upstream_resource() const
+    {
+        return m_pool.upstream_resource();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    PoolOptions SynchronizedPoolResource::options() const
+    {
+        return m_pool.options();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void* SynchronizedPoolResource::do_allocate(std::size_t bytes, std::size_t align)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pool.allocate(bytes, align);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void SynchronizedPoolResource::do_deallocate(void* ptr, std::size_t bytes, std::size_t align)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pool.deallocate(ptr, bytes, align);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    bool SynchronizedPoolResource::do_is_equal(const MemoryResource& other) const noexcept
+    {
+        return this == &other;
+    }
+};
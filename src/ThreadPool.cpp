@@ -0,0 +1,244 @@
+#include <ThreadPool.hpp>
+#include <chrono>
+
+namespace custom
+{
+    namespace
+    {
+        thread_local ThreadPool* t_pool = nullptr;
+        thread_local std::size_t t_index = 0;
+        thread_local std::size_t t_helpDepth = 0;
+
+        // a waiter runs stolen tasks on its own stack; past this nesting it only takes
+        // tasks from its own deque, which are children of the frames already on the stack
+        constexpr std::size_t kMaxHelpDepth = 32;
+
+        // upper bound on how long a parked waiter goes without looking for new work
+        constexpr std::chrono::microseconds kParkInterval(200);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    ThreadPool::ThreadPool(std::size_t workers, std::size_t cutoff)
+        : m_workerCount(workers ? workers : 1),
+          m_queues(new Queue[m_workerCount]),
+          m_threads(new std::thread[m_workerCount]),
+          m_cutoff(cutoff ? cutoff : 1)
+    {
+        try
+        {
+            for (std::size_t i = 0; i < m_workerCount; ++i)
+                m_threads[i] = std::thread(&ThreadPool::worker_loop, this, i);
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+                m_stop = true;
+            }
+            m_wake.notify_all();
+
+            for (std::size_t i = 0; i < m_workerCount; ++i)
+                if (m_threads[i].joinable()) m_threads[i].join();
+            throw;
+        }
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+
+        for (std::size_t i = 0; i < m_workerCount; ++i)
+            if (m_threads[i].joinable()) m_threads[i].join();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    std::size_t ThreadPool::worker_count() const
+    {
+        return m_workerCount;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    std::size_t ThreadPool::sequential_cutoff() const
+    {
+        return m_cutoff.load(std::memory_order_relaxed);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void ThreadPool::set_sequential_cutoff(std::size_t cutoff)
+    {
+        m_cutoff.store(cutoff ? cutoff : 1, std::memory_order_relaxed);
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void ThreadPool::submit(std::function<void()> task)
+    {
+        std::size_t index = t_pool == this ? t_index : m_nextQueue++ % m_workerCount;
+
+        // counted before it is published, so a thief can never decrement below zero
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            ++m_pending;
+        }
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(m_queues[index].m_mutex);
+            m_queues[index].m_tasks.push_back(std::move(task));
+        }
+        catch (...)
+        {
+            --m_pending;
+            throw;
+        }
+        m_wake.notify_one();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    bool ThreadPool::pop_task(std::size_t index, bool steal, std::function<void()>& task)
+    {
+        if (t_pool == this)
+        {
+            Queue& own = m_queues[index];
+            std::lock_guard<std::mutex> lock(own.m_mutex);
+            if (!own.m_tasks.empty())
+            {
+                task = std::move(own.m_tasks.back());
+                own.m_tasks.pop_back();
+                return true;
+            }
+        }
+
+        for (std::size_t i = 1; steal && i <= m_workerCount; ++i)
+        {
+            Queue& victim = m_queues[(index + i) % m_workerCount];
+            std::lock_guard<std::mutex> lock(victim.m_mutex);
+            if (!victim.m_tasks.empty())
+            {
+                task = std::move(victim.m_tasks.front());
+                victim.m_tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    bool ThreadPool::run_pending_task()
+    {
+        std::size_t index = t_pool == this ? t_index : m_nextQueue.load() % m_workerCount;
+
+        std::function<void()> task;
+        if (!pop_task(index, true, task)) return false;
+
+        --m_pending;
+        task();
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    bool ThreadPool::help_while_waiting()
+    {
+        bool steal = t_helpDepth < kMaxHelpDepth;
+        if (!steal && t_pool != this) return false;
+
+        std::size_t index = t_pool == this ? t_index : m_nextQueue.load() % m_workerCount;
+
+        std::function<void()> task;
+        if (!pop_task(index, steal, task)) return false;
+
+        --m_pending;
+        ++t_helpDepth;
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            --t_helpDepth;
+            throw;
+        }
+        --t_helpDepth;
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void ThreadPool::worker_loop(std::size_t index)
+    {
+        t_pool = this;
+        t_index = index;
+
+        while (true)
+        {
+            if (run_pending_task()) continue;
+
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_wake.wait(lock, [this] { return m_stop || m_pending > 0; });
+            if (m_stop && m_pending == 0) return;
+        }
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    ThreadPool& ThreadPool::default_pool()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////
+    // ---------------------------------------------------------------------------------- //
+    TaskGroup::TaskGroup(ThreadPool& pool)
+        : m_pool(pool)
+    {}
+
+    // ---------------------------------------------------------------------------------- //
+    TaskGroup::~TaskGroup()
+    {
+        wait_tasks();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void TaskGroup::finish_task()
+    {
+        // decremented under the lock: once a waiter sees zero under the same lock, no task
+        // touches the group any more and it may be destroyed
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_active == 0) m_done.notify_all();
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void TaskGroup::wait_tasks()
+    {
+        while (true)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_active == 0) return;
+            }
+
+            if (m_pool.help_while_waiting()) continue;
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait_for(lock, kParkInterval, [this] { return m_active == 0; });
+        }
+    }
+
+    // ---------------------------------------------------------------------------------- //
+    void TaskGroup::wait()
+    {
+        wait_tasks();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_error)
+        {
+            std::exception_ptr error = m_error;
+            m_error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+};